@@ -0,0 +1,98 @@
+#pragma once
+#include <BWAPI/UnitType.h>
+#include <BWAPI/UpgradeType.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Build orders and tech goals are written as tables below instead of if/else
+// chains. Each table entry says which facts must hold before it can start and
+// which fact marks it as done. ZergHell keeps the current facts up to date from
+// unit events, and only re-derives which entries are ready when they change, so
+// choosing what to build on a frame is a mask test per ready entry.
+
+// Facts about our own units. Add new ones here and to buildFactRules.
+typedef std::uint32_t BuildFacts;
+enum BuildFact : BuildFacts {
+  HasSpawningPool = 1 << 0,
+  HasCompletedSpawningPool = 1 << 1,
+  HasFourColonies = 1 << 2,
+  HasExtractor = 1 << 3,
+  HasHydraliskDen = 1 << 4,
+  HasLair = 1 << 5,
+  HasThreeHatcheries = 1 << 6,
+  HasFiveHatcheries = 1 << 7
+};
+
+// A fact holds when we have at least count units of the given types,
+// completed ones only if completed is set.
+struct BuildFactRule {
+  BuildFact fact;
+  BWAPI::UnitTypes::Enum::Enum type;
+  BWAPI::UnitTypes::Enum::Enum otherType;
+  int count;
+  bool completed;
+};
+
+constexpr BuildFactRule buildFactRules[] = {
+  { HasSpawningPool, BWAPI::UnitTypes::Enum::Zerg_Spawning_Pool, BWAPI::UnitTypes::Enum::None, 1, false },
+  { HasCompletedSpawningPool, BWAPI::UnitTypes::Enum::Zerg_Spawning_Pool, BWAPI::UnitTypes::Enum::None, 1, true },
+  { HasFourColonies, BWAPI::UnitTypes::Enum::Zerg_Creep_Colony, BWAPI::UnitTypes::Enum::Zerg_Sunken_Colony, 4, false },
+  { HasExtractor, BWAPI::UnitTypes::Enum::Zerg_Extractor, BWAPI::UnitTypes::Enum::None, 1, false },
+  { HasHydraliskDen, BWAPI::UnitTypes::Enum::Zerg_Hydralisk_Den, BWAPI::UnitTypes::Enum::None, 1, false },
+  { HasLair, BWAPI::UnitTypes::Enum::Zerg_Lair, BWAPI::UnitTypes::Enum::None, 1, false },
+  { HasThreeHatcheries, BWAPI::UnitTypes::Enum::Zerg_Hatchery, BWAPI::UnitTypes::Enum::None, 3, false },
+  { HasFiveHatcheries, BWAPI::UnitTypes::Enum::Zerg_Hatchery, BWAPI::UnitTypes::Enum::Zerg_Lair, 5, false }
+};
+
+// Buildings our build drone places, in priority order. A step is ready once
+// every fact in needs holds and none in until does.
+struct BuildStep {
+  BWAPI::UnitTypes::Enum::Enum type;
+  BuildFacts needs;
+  BuildFacts until;
+};
+
+constexpr BuildStep droneBuildOrder[] = {
+  { BWAPI::UnitTypes::Enum::Zerg_Spawning_Pool, 0, HasSpawningPool },
+  { BWAPI::UnitTypes::Enum::Zerg_Creep_Colony, HasSpawningPool, HasFourColonies },
+  { BWAPI::UnitTypes::Enum::Zerg_Extractor, HasSpawningPool | HasFourColonies, HasExtractor },
+  { BWAPI::UnitTypes::Enum::Zerg_Hydralisk_Den, HasExtractor, HasHydraliskDen },
+  { BWAPI::UnitTypes::Enum::Zerg_Hatchery, 0, HasFiveHatcheries }
+};
+
+// Morphs and upgrades our buildings work towards, in priority order per building.
+// Upgrades are skipped once we have them.
+struct TechStep {
+  BWAPI::UnitTypes::Enum::Enum building;
+  BWAPI::UnitTypes::Enum::Enum morph;
+  BWAPI::UpgradeTypes::Enum::Enum upgrade;
+  BuildFacts needs;
+  BuildFacts until;
+};
+
+constexpr TechStep techOrder[] = {
+  { BWAPI::UnitTypes::Enum::Zerg_Creep_Colony, BWAPI::UnitTypes::Enum::Zerg_Sunken_Colony, BWAPI::UpgradeTypes::Enum::None, 0, 0 },
+  { BWAPI::UnitTypes::Enum::Zerg_Hatchery, BWAPI::UnitTypes::Enum::Zerg_Lair, BWAPI::UpgradeTypes::Enum::None, HasCompletedSpawningPool | HasThreeHatcheries, HasLair },
+  { BWAPI::UnitTypes::Enum::Zerg_Hydralisk_Den, BWAPI::UnitTypes::Enum::None, BWAPI::UpgradeTypes::Enum::Muscular_Augments, 0, 0 },
+  { BWAPI::UnitTypes::Enum::Zerg_Hydralisk_Den, BWAPI::UnitTypes::Enum::None, BWAPI::UpgradeTypes::Enum::Grooved_Spines, 0, 0 },
+  { BWAPI::UnitTypes::Enum::Zerg_Lair, BWAPI::UnitTypes::Enum::None, BWAPI::UpgradeTypes::Enum::Pneumatized_Carapace, 0, 0 }
+};
+
+// Bit i is set when steps[i] is ready under facts.
+typedef std::uint32_t ReadySteps;
+
+template <typename Step, std::size_t N>
+constexpr ReadySteps readySteps(const Step (&steps)[N], BuildFacts facts) {
+  static_assert(N <= 32, "ReadySteps only has room for 32 steps");
+  ReadySteps ready = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    if ((facts & steps[i].needs) == steps[i].needs
+      && !(facts & steps[i].until)) {
+      ready |= ReadySteps(1) << i;
+    }
+  }
+  return ready;
+}
+
+static_assert(readySteps(droneBuildOrder, 0) == 0b10001, "A new game should only be ready for a Spawning Pool and Hatcheries");
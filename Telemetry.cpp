@@ -0,0 +1,114 @@
+#include <BWAPI.h>
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Telemetry.h"
+
+static_assert(TelemetryUnitTypeCount == BWAPI::UnitTypes::Enum::MAX, "TelemetryUnitTypeCount is out of date with BWAPI");
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+  "Telemetry atomics must be lock free to live in shared memory");
+
+Telemetry::Telemetry() {
+  // Create the segment. Any failure just leaves telemetry disabled, the bot
+  // should never stop playing because nobody can watch it.
+#ifdef _WIN32
+  std::snprintf(name, sizeof(name), "Local\\ZergHell_%lu", GetCurrentProcessId());
+  auto handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(TelemetryBuffer), name);
+  if (!handle) {
+    return;
+  }
+  auto view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TelemetryBuffer));
+  if (!view) {
+    CloseHandle(handle);
+    return;
+  }
+  mapping = handle;
+#else
+  std::snprintf(name, sizeof(name), "/ZergHell_%ld", (long)getpid());
+  auto fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    return;
+  }
+  if (ftruncate(fd, sizeof(TelemetryBuffer)) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return;
+  }
+  auto view = mmap(nullptr, sizeof(TelemetryBuffer), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED) {
+    shm_unlink(name);
+    return;
+  }
+#endif
+  buffer = static_cast<TelemetryBuffer*>(view);
+
+  // A crashed process with the same pid may have left data behind, start clean.
+  // The magic is written last so a reader never sees a half initialized header.
+  buffer->magic = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  buffer->version = TelemetryVersion;
+  buffer->capacity = TelemetryCapacity;
+  buffer->match.store(0, std::memory_order_relaxed);
+  buffer->written.store(0, std::memory_order_relaxed);
+  for (auto& slot : buffer->slots) {
+    slot.sequence.store(0, std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  buffer->magic = TelemetryMagic;
+}
+
+Telemetry::~Telemetry() {
+  if (!buffer) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(buffer);
+  CloseHandle(mapping);
+#else
+  munmap(buffer, sizeof(TelemetryBuffer));
+  shm_unlink(name);
+#endif
+}
+
+void Telemetry::publish(const TelemetrySample& sample) {
+  if (!buffer) {
+    return;
+  }
+
+  // We are the only writer, so the counter can be read relaxed.
+  auto written = buffer->written.load(std::memory_order_relaxed);
+  auto& slot = buffer->slots[written % TelemetryCapacity];
+  auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.sample = sample;
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+
+  buffer->written.store(written + 1, std::memory_order_release);
+}
+
+void Telemetry::reset() {
+  if (!buffer) {
+    return;
+  }
+
+  // Bump the match first so a reader notices the reset even if it only sees
+  // part of it, then empty the ring in place. Readers keep their mapping.
+  buffer->match.fetch_add(1, std::memory_order_release);
+  buffer->written.store(0, std::memory_order_release);
+  for (auto& slot : buffer->slots) {
+    slot.sequence.store(0, std::memory_order_release);
+  }
+}
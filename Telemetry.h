@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// Per-frame counters published into a named shared memory segment so an
+// external monitor can watch running games without slowing the bot down.
+// Everything in this header is plain data so a reader only needs to include
+// this file, map the segment read-only and tail the ring.
+//
+// The segment is named "ZergHell_<process id>" ("Local\ZergHell_<pid>" on
+// Windows, "/ZergHell_<pid>" with shm_open elsewhere) so several bots on one
+// host do not collide. The segment lives as long as the bot process, so a
+// monitor can attach before the first match and keep reading across matches;
+// the ring is reset at the start of each match. Windows frees the mapping once no process has it
+// open, but on POSIX a bot that crashes leaves /dev/shm/ZergHell_<pid>
+// behind, so a monitor should shm_unlink segments whose pid is no longer
+// running.
+
+// The order here matches the order ZergHell::onFrame runs its managers.
+enum TelemetryManager {
+  TelemetryAssignIdleWorkers,
+  TelemetryCheckArmy,
+  TelemetryCheckBuildDrone,
+  TelemetryCheckBuildings,
+  TelemetryCheckScout,
+  TelemetryCheckEggs,
+  TelemetryMorphLarva,
+  TelemetryCheckEnemyBuildings,
+  TelemetryDebugDraws,
+  TelemetryManagerCount
+};
+
+const char* const TelemetryManagerNames[] = {
+  "assignIdleWorkers",
+  "checkArmy",
+  "checkBuildDrone",
+  "checkBuildings",
+  "checkScout",
+  "checkEggs",
+  "morphLarva",
+  "checkEnemyBuildings",
+  "debugDraws"
+};
+static_assert(std::size(TelemetryManagerNames) == TelemetryManagerCount, "Every TelemetryManager needs a name");
+
+const std::uint32_t TelemetryMagic = 0x5A484C4C; // "ZHLL"
+// Bump whenever the layout of the structs below changes.
+const std::uint32_t TelemetryVersion = 3;
+// Must match BWAPI::UnitTypes::Enum::MAX, checked in Telemetry.cpp.
+const int TelemetryUnitTypeCount = 234;
+// Number of frames kept in the ring, roughly 40 seconds of game time on fastest.
+const std::uint32_t TelemetryCapacity = 1024;
+
+// The structs below are shared between processes that may be built for
+// different architectures or with different compilers, so all padding is
+// explicit and the layout is pinned by the static_asserts after each one.
+struct TelemetrySample {
+  std::int32_t frame;
+  std::int32_t padding;
+  std::int64_t managerMicroseconds[TelemetryManagerCount];
+  // Our own units, indexed by BWAPI::UnitType id.
+  std::int32_t unitCounts[TelemetryUnitTypeCount];
+  // Units that were given a command this frame.
+  std::int32_t commandsIssued;
+  std::int32_t supplyUsed;
+  std::int32_t supplyTotal;
+  // supplyTotal plus morphing Overlords, capped at 400 like supplyTotal.
+  std::int32_t supplyProjected;
+  std::int32_t attack;
+  std::int32_t padding2;
+};
+static_assert(offsetof(TelemetrySample, managerMicroseconds) == 8, "TelemetrySample layout changed");
+static_assert(offsetof(TelemetrySample, unitCounts) == 8 + 8 * TelemetryManagerCount, "TelemetrySample layout changed");
+static_assert(offsetof(TelemetrySample, commandsIssued) == 8 + 8 * TelemetryManagerCount + 4 * TelemetryUnitTypeCount, "TelemetrySample layout changed");
+static_assert(offsetof(TelemetrySample, attack) == offsetof(TelemetrySample, commandsIssued) + 16, "TelemetrySample layout changed");
+static_assert(sizeof(TelemetrySample) == offsetof(TelemetrySample, attack) + 8, "TelemetrySample layout changed");
+static_assert(sizeof(TelemetrySample) % 8 == 0, "TelemetrySample must keep its int64 fields 8 byte aligned in a slot");
+
+struct TelemetrySlot {
+  // Odd while the bot is writing the slot, and 2 * n once it holds the nth
+  // sample written to it, so sample index i is complete in its slot when the
+  // sequence is 2 * (i / capacity + 1). A reader acquire-loads the sequence,
+  // copies the sample, fences, and keeps the copy only if the sequence still
+  // matches. See tools/TelemetryReader.cpp.
+  std::atomic<std::uint32_t> sequence;
+  std::uint32_t padding;
+  TelemetrySample sample;
+};
+static_assert(sizeof(std::atomic<std::uint32_t>) == 4 && sizeof(std::atomic<std::uint64_t>) == 8, "Telemetry atomics must be plain integers");
+static_assert(offsetof(TelemetrySlot, sample) == 8, "TelemetrySlot layout changed");
+static_assert(sizeof(TelemetrySlot) == 8 + sizeof(TelemetrySample), "TelemetrySlot layout changed");
+
+struct TelemetryBuffer {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t capacity;
+  // Bumped by Telemetry::reset() at the start of every match. A reader that
+  // sees it change starts over from sample 0.
+  std::atomic<std::uint32_t> match;
+  // Total samples published. The newest one lives in slot (written - 1) % capacity.
+  std::atomic<std::uint64_t> written;
+  TelemetrySlot slots[TelemetryCapacity];
+};
+static_assert(offsetof(TelemetryBuffer, match) == 12, "TelemetryBuffer layout changed");
+static_assert(offsetof(TelemetryBuffer, written) == 16, "TelemetryBuffer layout changed");
+static_assert(offsetof(TelemetryBuffer, slots) == 24, "TelemetryBuffer layout changed");
+static_assert(sizeof(TelemetryBuffer) == 24 + sizeof(TelemetrySlot) * TelemetryCapacity, "TelemetryBuffer layout changed");
+
+// Single producer side of the ring. Never blocks; if the segment can not be
+// created, reset() and publish() do nothing. Owned by main() for the life of
+// the process rather than by ZergHell, which is rebuilt every match.
+struct Telemetry {
+public:
+  Telemetry();
+  ~Telemetry();
+  Telemetry(const Telemetry&) = delete;
+  Telemetry& operator=(const Telemetry&) = delete;
+  void publish(const TelemetrySample& sample);
+  void reset();
+private:
+  TelemetryBuffer* buffer = nullptr;
+#ifdef _WIN32
+  // File mapping HANDLE, kept as void* so this header does not need windows.h.
+  void* mapping = nullptr;
+#endif
+  char name[64] = {};
+};
@@ -1,5 +1,9 @@
 #include <BWAPI.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
 #include "ZergHell.h"
 
 enum ClientInfoKeys {
@@ -16,18 +20,52 @@ enum ClientInfoKeys {
 
 
 void ZergHell::onFrame() {
-  assignIdleWorkers();
-  checkArmy();
-  checkBuildDrone();
-  checkBuildings();
-  checkScout();
-  checkEggs();
-  morphLarva();
-  checkEnemyBuildings();
-  debugDraws();
+  // Managers in the order they run, indexed by TelemetryManager so each
+  // one's frame time lands in the right telemetry counter.
+  static void (ZergHell::* const managers[])() = {
+    &ZergHell::assignIdleWorkers,
+    &ZergHell::checkArmy,
+    &ZergHell::checkBuildDrone,
+    &ZergHell::checkBuildings,
+    &ZergHell::checkScout,
+    &ZergHell::checkEggs,
+    &ZergHell::morphLarva,
+    &ZergHell::checkEnemyBuildings,
+    &ZergHell::debugDraws
+  };
+  static_assert(std::size(managers) == TelemetryManagerCount, "Every TelemetryManager needs an entry in managers");
+
+  TelemetrySample sample = {};
+  for (int manager = 0; manager < TelemetryManagerCount; manager++) {
+    auto start = std::chrono::steady_clock::now();
+    (this->*managers[manager])();
+    sample.managerMicroseconds[manager] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+  publishTelemetry(sample);
+}
+
+void ZergHell::onUnitDestroy(BWAPI::Unit unit) {
+  untrackUnit(unit);
+  updateBuildFacts();
 }
 
-ZergHell::ZergHell() {
+void ZergHell::onUnitUpdate(BWAPI::Unit unit) {
+  // Called when a unit is created, morphs, completes or changes owner.
+  // Recount it under its current type if it is ours.
+  untrackUnit(unit);
+  if (unit->getPlayer() == self) {
+    auto type = unit->getType();
+    auto completed = unit->isCompleted();
+    trackedUnits[unit] = { type, completed };
+    unitCounts[type]++;
+    if (completed) {
+      completedUnitCounts[type]++;
+    }
+  }
+  updateBuildFacts();
+}
+
+ZergHell::ZergHell(Telemetry& telemetry) : telemetry(telemetry) {
   // Set the self pointer, which is used in place of always calling
   // the BWAPI::Broodwar->self() function.
   self = BWAPI::Broodwar->self();
@@ -44,6 +82,11 @@ ZergHell::ZergHell() {
 
   defensePoint = (BWAPI::Position)self->getStartLocation();
 
+  // Track the units we start with, later changes come in through unit events.
+  for (auto& unit : self->getUnits()) {
+    onUnitUpdate(unit);
+  }
+
   // Group resources by their Resource ID for determining base locations.
   std::map<int, std::vector<BWAPI::Unit>> resources;
   // Loop through all mineral patches.
@@ -281,30 +324,14 @@ void ZergHell::checkBuildDrone() {
   // only sending one drone out at a time to build.
 
   // If we don't have a build drone, lets see if we need to build anything.
+  // Take the first ready step of the build order we can afford.
   if (!buildDrone) {
-    if (!self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Spawning_Pool)
-      && canAfford(BWAPI::UnitTypes::Zerg_Spawning_Pool)) {
-      build(BWAPI::UnitTypes::Zerg_Spawning_Pool);
-    }
-    else if (self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Spawning_Pool)
-      && self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Creep_Colony) + self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Sunken_Colony) < 4
-      && canAfford(BWAPI::UnitTypes::Zerg_Creep_Colony)) {
-      build(BWAPI::UnitTypes::Zerg_Creep_Colony);
-    }
-    else if (self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Spawning_Pool)
-      && self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Creep_Colony) + self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Sunken_Colony) >= 4
-      && self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Extractor) < 1
-      && canAfford(BWAPI::UnitTypes::Zerg_Extractor)) {
-      build(BWAPI::UnitTypes::Zerg_Extractor);
-    }
-    else if (self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Extractor)
-      && self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Hydralisk_Den) < 1
-      && canAfford(BWAPI::UnitTypes::Zerg_Hydralisk_Den)) {
-      build(BWAPI::UnitTypes::Zerg_Hydralisk_Den);
-    }
-    else if (self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Hatchery) + self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Lair) < 5
-      && canAfford(BWAPI::UnitTypes::Zerg_Hatchery)) {
-      build(BWAPI::UnitTypes::Zerg_Hatchery);
+    for (std::size_t step = 0; step < std::size(droneBuildOrder); step++) {
+      if (readyBuilds & (ReadySteps(1) << step)
+        && canAfford(BWAPI::UnitType(droneBuildOrder[step].type))) {
+        build(BWAPI::UnitType(droneBuildOrder[step].type));
+        break;
+      }
     }
   }
   // We have a build drone, lets see if we need to do something with it or unassign it.
@@ -423,28 +450,11 @@ void ZergHell::checkBuildings() {
         gasWorker->gather(unit);
       }
     }
-    else if (unit->getType() == BWAPI::UnitTypes::Zerg_Creep_Colony) {
-      if (canAfford(BWAPI::UnitTypes::Zerg_Sunken_Colony)) {
-        unit->morph(BWAPI::UnitTypes::Zerg_Sunken_Colony);
-      }
-    }
-    else if (unit->getType() == BWAPI::UnitTypes::Zerg_Hydralisk_Den) {
-      if (!self->getUpgradeLevel(BWAPI::UpgradeTypes::Muscular_Augments)
-        && canAfford(BWAPI::UpgradeTypes::Muscular_Augments)) {
-        unit->upgrade(BWAPI::UpgradeTypes::Muscular_Augments);
-      }
-      else if (!self->getUpgradeLevel(BWAPI::UpgradeTypes::Grooved_Spines)
-        && canAfford(BWAPI::UpgradeTypes::Grooved_Spines)) {
-        unit->upgrade(BWAPI::UpgradeTypes::Grooved_Spines);
-      }
+    else {
+      checkTech(unit);
     }
-    else if (unit->getType() == BWAPI::UnitTypes::Zerg_Hatchery) {
-      if (self->completedUnitCount(BWAPI::UnitTypes::Zerg_Spawning_Pool)
-        && !self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Lair)
-        && 2 < self->visibleUnitCount(BWAPI::UnitTypes::Zerg_Hatchery)
-        && canAfford(BWAPI::UnitTypes::Zerg_Lair)) {
-        unit->morph(BWAPI::UnitTypes::Zerg_Lair);
-      }
+
+    if (unit->getType() == BWAPI::UnitTypes::Zerg_Hatchery) {
       // find a worker for defense if our hatchery is under attack and we have no Hydralisks, trying to keep starting buildings from dying or taking 
       // heavy damage from enemy scouts/workers.
       if (unit->isUnderAttack()
@@ -461,11 +471,30 @@ void ZergHell::checkBuildings() {
         }
       }
     }
-    else if (unit->getType() == BWAPI::UnitTypes::Zerg_Lair) {
-      if (canAfford(BWAPI::UpgradeTypes::Pneumatized_Carapace)) {
-        unit->upgrade(BWAPI::UpgradeTypes::Pneumatized_Carapace);
+  }
+}
+
+void ZergHell::checkTech(BWAPI::Unit unit) {
+  // Morph or upgrade towards the first ready tech step for this building
+  // that we can afford.
+  for (std::size_t step = 0; step < std::size(techOrder); step++) {
+    auto& tech = techOrder[step];
+    if (!(readyTech & (ReadySteps(1) << step))
+      || unit->getType() != tech.building) {
+      continue;
+    }
+
+    if (tech.morph != BWAPI::UnitTypes::Enum::None) {
+      if (canAfford(BWAPI::UnitType(tech.morph))) {
+        unit->morph(BWAPI::UnitType(tech.morph));
+        return;
       }
     }
+    else if (!self->getUpgradeLevel(BWAPI::UpgradeType(tech.upgrade))
+      && canAfford(BWAPI::UpgradeType(tech.upgrade))) {
+      unit->upgrade(BWAPI::UpgradeType(tech.upgrade));
+      return;
+    }
   }
 }
 
@@ -594,4 +623,61 @@ bool ZergHell::needSupply() {
   }
 
   return self->supplyUsed() >= supplyTotal - 4;
+}
+
+void ZergHell::publishTelemetry(TelemetrySample& sample) {
+  // Fill in the game state counters and hand the sample to the ring buffer.
+  auto frame = BWAPI::Broodwar->getFrameCount();
+  sample.frame = frame;
+  // Count units straight from getUnits() rather than copying unitCounts, so
+  // a monitor can spot the event tracking drifting from what BWAPI reports.
+  int supplyMorphing = 0;
+  for (auto& unit : self->getUnits()) {
+    sample.unitCounts[unit->getType()]++;
+    if (unit->getLastCommandFrame() == frame) {
+      sample.commandsIssued++;
+    }
+    if (unit->getType() == BWAPI::UnitTypes::Zerg_Egg
+      && unit->getClientInfo<int>(morphingType) == BWAPI::UnitTypes::Zerg_Overlord) {
+      supplyMorphing += BWAPI::UnitTypes::Zerg_Overlord.supplyProvided();
+    }
+  }
+  sample.supplyUsed = self->supplyUsed();
+  sample.supplyTotal = self->supplyTotal();
+  // Supply is capped at 200, which BWAPI doubles to 400.
+  sample.supplyProjected = (std::min)(self->supplyTotal() + supplyMorphing, 400);
+  sample.attack = attack;
+  telemetry.publish(sample);
+}
+
+void ZergHell::untrackUnit(BWAPI::Unit unit) {
+  auto tracked = trackedUnits.find(unit);
+  if (tracked == trackedUnits.end()) {
+    return;
+  }
+
+  auto& trackedUnit = tracked->second;
+  unitCounts[trackedUnit.type]--;
+  if (trackedUnit.completed) {
+    completedUnitCounts[trackedUnit.type]--;
+  }
+  trackedUnits.erase(tracked);
+}
+
+void ZergHell::updateBuildFacts() {
+  // Re-derive the facts from our unit counts, then which build and tech
+  // steps they make ready. Only runs on unit events, never per frame.
+  buildFacts = 0;
+  for (auto& rule : buildFactRules) {
+    auto counts = rule.completed ? completedUnitCounts : unitCounts;
+    auto count = counts[rule.type];
+    if (rule.otherType != BWAPI::UnitTypes::Enum::None) {
+      count += counts[rule.otherType];
+    }
+    if (rule.count <= count) {
+      buildFacts |= rule.fact;
+    }
+  }
+  readyBuilds = readySteps(droneBuildOrder, buildFacts);
+  readyTech = readySteps(techOrder, buildFacts);
 }
\ No newline at end of file
@@ -1,10 +1,22 @@
 #pragma once
 #include <map>
 
+#include "BuildOrder.h"
+#include "Telemetry.h"
+
+// What we last counted a unit as, so the counts can be undone when it
+// morphs, completes, changes owner or dies.
+struct TrackedUnit {
+  BWAPI::UnitType type;
+  bool completed;
+};
+
 struct ZergHell {
 public:
   void onFrame();
-  ZergHell();
+  void onUnitDestroy(BWAPI::Unit unit);
+  void onUnitUpdate(BWAPI::Unit unit);
+  ZergHell(Telemetry& telemetry);
 private:
   int armyResourceID = 1;
   int armyResourceIDMax = 1;
@@ -12,6 +24,7 @@ private:
   bool attack = false;
   std::map<int, BWAPI::TilePosition> baseLocations;
   void build(BWAPI::UnitType type);
+  BuildFacts buildFacts = 0;
   BWAPI::Unit buildDrone = nullptr;
   bool canAfford(BWAPI::UnitType type);
   bool canAfford(BWAPI::UpgradeType type);
@@ -21,14 +34,24 @@ private:
   void checkEggs();
   void checkEnemyBuildings();
   void checkScout();
+  void checkTech(BWAPI::Unit unit);
+  int completedUnitCounts[BWAPI::UnitTypes::Enum::MAX] = {};
   void debugDraws();
   BWAPI::Position defensePoint;
   BWAPI::Unit detector = nullptr;
   std::map<BWAPI::TilePosition, BWAPI::UnitType> fogOfWarBuildings;
   void morphLarva();
   bool needSupply();
+  void publishTelemetry(TelemetrySample& sample);
+  ReadySteps readyBuilds = 0;
+  ReadySteps readyTech = 0;
   BWAPI::Unit scout = nullptr;
   BWAPI::Player self;
   std::map<BWAPI::TilePosition, bool> startLocations;
+  Telemetry& telemetry;
+  std::map<BWAPI::Unit, TrackedUnit> trackedUnits;
+  int unitCounts[BWAPI::UnitTypes::Enum::MAX] = {};
+  void untrackUnit(BWAPI::Unit unit);
+  void updateBuildFacts();
   int clearBuildDroneCounter = 0;
 };
\ No newline at end of file
@@ -19,6 +19,8 @@ void reconnect() {
 int main() {
   std::cout << "Connecting..." << std::endl;
   reconnect();
+  // Telemetry outlives each match so a monitor can stay attached between games.
+  Telemetry telemetry;
   while (true) {
     std::unique_ptr<ZergHell> bot;
     std::cout << "waiting to enter match" << std::endl;
@@ -35,7 +37,21 @@ int main() {
       for (auto& e : BWAPI::Broodwar->getEvents()) {
         switch (e.getType()) {
         case BWAPI::EventType::MatchStart:
-          bot = std::make_unique<ZergHell>();
+          telemetry.reset();
+          bot = std::make_unique<ZergHell>(telemetry);
+          break;
+        case BWAPI::EventType::UnitCreate:
+        case BWAPI::EventType::UnitMorph:
+        case BWAPI::EventType::UnitComplete:
+        case BWAPI::EventType::UnitRenegade:
+          if (bot) {
+            bot->onUnitUpdate(e.getUnit());
+          }
+          break;
+        case BWAPI::EventType::UnitDestroy:
+          if (bot) {
+            bot->onUnitDestroy(e.getUnit());
+          }
           break;
         default:
           break;
@@ -0,0 +1,234 @@
+// Tails the telemetry ring of a running ZergHell and prints aggregated
+// counters every few seconds of game time.
+//
+// Usage: TelemetryReader <bot pid>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "../Telemetry.h"
+
+// Print a report every 240 samples, 10 seconds of game time on fastest.
+const int reportFrames = 240;
+
+struct Aggregate {
+  int samples = 0;
+  std::int32_t firstFrame = 0;
+  std::int64_t managerTotal[TelemetryManagerCount] = {};
+  std::int64_t managerMax[TelemetryManagerCount] = {};
+  std::int64_t commandsIssued = 0;
+  std::uint64_t dropped = 0;
+  TelemetrySample last = {};
+};
+
+bool botRunning(long pid) {
+#ifdef _WIN32
+  auto process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)pid);
+  if (!process) {
+    return false;
+  }
+  auto running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+  CloseHandle(process);
+  return running;
+#else
+  return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+#endif
+}
+
+const TelemetryBuffer* openBuffer(long pid) {
+  char name[64];
+#ifdef _WIN32
+  std::snprintf(name, sizeof(name), "Local\\ZergHell_%ld", pid);
+  auto handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+  if (!handle) {
+    return nullptr;
+  }
+  // The view keeps the mapping alive, the handle is not needed past this.
+  auto view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, sizeof(TelemetryBuffer));
+  CloseHandle(handle);
+  return static_cast<const TelemetryBuffer*>(view);
+#else
+  std::snprintf(name, sizeof(name), "/ZergHell_%ld", pid);
+  auto fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  // A crashed bot can not unlink its own segment, so clean it up for it.
+  if (!botRunning(pid)) {
+    std::cerr << "bot " << pid << " is not running, removing " << name << std::endl;
+    close(fd);
+    shm_unlink(name);
+    return nullptr;
+  }
+  auto view = mmap(nullptr, sizeof(TelemetryBuffer), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  return view == MAP_FAILED ? nullptr : static_cast<const TelemetryBuffer*>(view);
+#endif
+}
+
+bool readSample(const TelemetryBuffer& buffer, std::uint64_t index, TelemetrySample& sample) {
+  // Copy sample index out of its slot. Returns false if the bot has already
+  // lapped the ring and reused the slot for a newer sample, or reset the ring
+  // for a new match.
+  auto& slot = buffer.slots[index % TelemetryCapacity];
+  auto expected = std::uint32_t(2 * (index / TelemetryCapacity + 1));
+  for (int attempt = 0; attempt < 16; attempt++) {
+    auto before = slot.sequence.load(std::memory_order_acquire);
+    if (before < expected) {
+      // The bot publishes the sequence before written, so for an index below
+      // written this only happens while the ring is being reset.
+      if (buffer.written.load(std::memory_order_acquire) <= index) {
+        return false;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+    if (before != expected) {
+      return false;
+    }
+    std::memcpy(&sample, &slot.sample, sizeof(sample));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+  }
+  return false;
+}
+
+bool checkHeader(const TelemetryBuffer& buffer, long pid) {
+  // The bot writes the magic last, so give a bot that is just starting up a
+  // moment to finish the header before giving up on it.
+  for (int attempt = 0; attempt < 100 && buffer.magic != TelemetryMagic; attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+  }
+  if (buffer.magic != TelemetryMagic) {
+    std::cerr << "telemetry for bot " << pid << " has magic " << std::hex << buffer.magic
+      << ", expected " << TelemetryMagic << std::dec << std::endl;
+    return false;
+  }
+  if (buffer.version != TelemetryVersion) {
+    std::cerr << "telemetry for bot " << pid << " has version " << buffer.version
+      << ", this reader expects " << TelemetryVersion << std::endl;
+    return false;
+  }
+  if (buffer.capacity != TelemetryCapacity) {
+    std::cerr << "telemetry for bot " << pid << " has capacity " << buffer.capacity
+      << ", this reader expects " << TelemetryCapacity << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void report(const Aggregate& aggregate) {
+  auto& last = aggregate.last;
+  std::cout << "frames " << aggregate.firstFrame << "-" << last.frame
+    << "  supply " << last.supplyUsed / 2 << "/" << last.supplyTotal / 2 << " (" << last.supplyProjected / 2 << ")"
+    << "  commands/frame " << std::fixed << std::setprecision(1) << double(aggregate.commandsIssued) / aggregate.samples
+    << "  attack " << (last.attack ? "yes" : "no")
+    << "  dropped " << aggregate.dropped << std::endl;
+  std::int64_t frameTotal = 0;
+  for (int manager = 0; manager < TelemetryManagerCount; manager++) {
+    frameTotal += aggregate.managerTotal[manager];
+    std::cout << "  " << std::left << std::setw(22) << TelemetryManagerNames[manager] << std::right
+      << " avg " << std::setw(8) << double(aggregate.managerTotal[manager]) / aggregate.samples << "us"
+      << "  max " << std::setw(6) << aggregate.managerMax[manager] << "us" << std::endl;
+  }
+  std::cout << "  " << std::left << std::setw(22) << "total" << std::right
+    << " avg " << std::setw(8) << double(frameTotal) / aggregate.samples << "us" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " <bot pid>" << std::endl;
+    return 1;
+  }
+  auto pid = std::strtol(argv[1], nullptr, 10);
+
+  auto buffer = openBuffer(pid);
+  if (!buffer) {
+    std::cerr << "no telemetry found for bot " << pid << std::endl;
+    return 1;
+  }
+  if (!checkHeader(*buffer, pid)) {
+    return 1;
+  }
+
+  // Start from the newest sample rather than replaying the whole ring.
+  auto match = buffer->match.load(std::memory_order_acquire);
+  auto next = buffer->written.load(std::memory_order_acquire);
+  Aggregate aggregate;
+  while (true) {
+    // A new match in the same bot process resets the ring, start over.
+    auto currentMatch = buffer->match.load(std::memory_order_acquire);
+    auto written = buffer->written.load(std::memory_order_acquire);
+    if (currentMatch != match) {
+      if (aggregate.samples) {
+        report(aggregate);
+      }
+      std::cout << "match " << currentMatch << " started" << std::endl;
+      match = currentMatch;
+      next = 0;
+      aggregate = Aggregate();
+      continue;
+    }
+    // The bot bumps match before emptying the ring, so this is a reset that
+    // landed between the two loads above. The next pass sees the new match.
+    if (written < next) {
+      continue;
+    }
+    if (next == written) {
+      if (!botRunning(pid)) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+      continue;
+    }
+    if (TelemetryCapacity < written - next) {
+      aggregate.dropped += written - next - TelemetryCapacity;
+      next = written - TelemetryCapacity;
+    }
+
+    TelemetrySample sample;
+    if (!readSample(*buffer, next++, sample)) {
+      aggregate.dropped++;
+      continue;
+    }
+    if (!aggregate.samples) {
+      aggregate.firstFrame = sample.frame;
+    }
+    aggregate.samples++;
+    for (int manager = 0; manager < TelemetryManagerCount; manager++) {
+      aggregate.managerTotal[manager] += sample.managerMicroseconds[manager];
+      if (aggregate.managerMax[manager] < sample.managerMicroseconds[manager]) {
+        aggregate.managerMax[manager] = sample.managerMicroseconds[manager];
+      }
+    }
+    aggregate.commandsIssued += sample.commandsIssued;
+    aggregate.last = sample;
+
+    if (aggregate.samples == reportFrames) {
+      report(aggregate);
+      aggregate = Aggregate();
+    }
+  }
+
+  if (aggregate.samples) {
+    report(aggregate);
+  }
+  std::cout << "bot " << pid << " exited" << std::endl;
+}